@@ -0,0 +1,215 @@
+// Host-side checks for the platform-independent render path: config swaps, crossfades and the
+// delay line. Drives RenderToBuffer directly with a fake device, so no audio hardware is needed.
+
+#include "../ua_api.c"
+#include <stdio.h>
+
+#define FRAMES_PER_BUFFER 4
+#define NUM_CHANNELS 2
+#define MAX_LATENCY_MS 10
+#define SAMPLE_RATE 1000 // one frame per millisecond keeps delays easy to reason about
+
+#define CHECK(x) do { if (!(x)) { \
+    printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); return 1; } } while(0)
+
+static int gNumAllocations;
+static unsigned gFrameCounter;
+static float gOutput[FRAMES_PER_BUFFER * NUM_CHANNELS];
+
+static void* CountingAllocate(unsigned numBytes) { ++gNumAllocations; return malloc(numBytes); }
+static void CountingFree(void* p) { --gNumAllocations; free(p); }
+
+// Left carries the running frame number, right carries 100 + the frame number.
+static void FrameCounterCallback(float* buffer, unsigned numFrames, unsigned numChannels)
+{
+    for (unsigned frame = 0; frame < numFrames; ++frame, ++gFrameCounter)
+    {
+        buffer[frame * numChannels + 0] = (float)gFrameCounter;
+        buffer[frame * numChannels + 1] = (float)(100 + gFrameCounter);
+    }
+}
+
+static unsigned RenderBuffer(void)
+{
+    ua_AudioBuffer target = { gOutput, 0, FRAMES_PER_BUFFER, NUM_CHANNELS };
+    const unsigned FirstFrame = gFrameCounter;
+    RenderToBuffer(&target);
+    return FirstFrame;
+}
+
+static float Delayed(unsigned frame, unsigned delayFrames, float offset)
+{
+    return frame < delayFrames ? 0.f : offset + (float)(frame - delayFrames);
+}
+
+static int Near(float a, float b)
+{
+    return fabsf(a - b) < 1e-4f;
+}
+
+// Checks one buffer fading from (fromDelay, fromScale) to (toDelay, toScale) on one channel.
+static int CheckFade(unsigned firstFrame, unsigned channel, float offset,
+                     unsigned fromDelay, float fromScale, unsigned toDelay, float toScale)
+{
+    for (unsigned i = 0; i < FRAMES_PER_BUFFER; ++i)
+    {
+        const float FadeIn = (float)i / FRAMES_PER_BUFFER;
+        const float From = Delayed(firstFrame + i, fromDelay, offset) * fromScale;
+        const float To = Delayed(firstFrame + i, toDelay, offset) * toScale;
+        if (!Near(gOutput[i * NUM_CHANNELS + channel], From * (1.f - FadeIn) + To * FadeIn))
+        {
+            printf("frame %u channel %u: got %f\n", firstFrame + i, channel,
+                   (double)gOutput[i * NUM_CHANNELS + channel]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int CheckSteady(unsigned firstFrame, unsigned channel, float offset,
+                       unsigned delay, float scale)
+{
+    return CheckFade(firstFrame, channel, offset, delay, scale, delay, scale);
+}
+
+static int TestGainAndMapChanges(void)
+{
+    unsigned first = RenderBuffer();
+    CHECK(CheckSteady(first, 0, 0.f, 0, 1.f));
+    CHECK(CheckSteady(first, 1, 100.f, 0, 1.f));
+
+    CHECK(ua_set_scale_factor(0, 0.5f) == UA_SUCCESS);
+    first = RenderBuffer();
+    CHECK(CheckFade(first, 0, 0.f, 0, 1.f, 0, 0.5f));
+    CHECK(CheckSteady(first, 1, 100.f, 0, 1.f));
+    first = RenderBuffer();
+    CHECK(CheckSteady(first, 0, 0.f, 0, 0.5f));
+
+    // Swap left and right; the gain set above travels with connection 0.
+    ua_ChannelMap map;
+    CHECK(ua_get_channel_map(&map) == UA_SUCCESS);
+    map.connections[0].sinkChannel = 1;
+    map.connections[1].sinkChannel = 0;
+    CHECK(ua_set_channel_map(&map) == UA_SUCCESS);
+    first = RenderBuffer();
+    for (unsigned i = 0; i < FRAMES_PER_BUFFER; ++i)
+    {
+        const float FadeIn = (float)i / FRAMES_PER_BUFFER;
+        const float Left = (float)(first + i), Right = (float)(100 + first + i);
+        CHECK(Near(gOutput[i * NUM_CHANNELS + 0], 0.5f * Left * (1.f - FadeIn) + Right * FadeIn));
+        CHECK(Near(gOutput[i * NUM_CHANNELS + 1], Right * (1.f - FadeIn) + 0.5f * Left * FadeIn));
+    }
+    return 0;
+}
+
+static int TestSupersededConfig(void)
+{
+    // Connection 0 routes left into the right channel since the swap above.
+    CHECK(ua_set_scale_factor(0, 0.25f) == UA_SUCCESS);
+    CHECK(ua_set_scale_factor(0, 0.75f) == UA_SUCCESS); // replaces the pending one
+    const unsigned First = RenderBuffer();
+    CHECK(CheckFade(First, 1, 0.f, 0, 0.5f, 0, 0.75f));
+    return 0;
+}
+
+static int TestLatencyChanges(void)
+{
+    ua_ChannelMap map;
+    CHECK(ua_get_channel_map(&map) == UA_SUCCESS);
+    map.connections[0].sinkChannel = 0;
+    map.connections[0].scaleFactor = 1.f;
+    map.connections[1].sinkChannel = 1;
+    map.connections[1].scaleFactor = 1.f;
+    CHECK(ua_set_channel_map(&map) == UA_SUCCESS);
+    RenderBuffer();
+
+    CHECK(ua_set_latency(MAX_LATENCY_MS) == UA_SUCCESS); // longer: reads existing history
+    unsigned first = RenderBuffer();
+    CHECK(CheckFade(first, 0, 0.f, 0, 1.f, MAX_LATENCY_MS, 1.f));
+    CHECK(CheckFade(first, 1, 100.f, 0, 1.f, MAX_LATENCY_MS, 1.f));
+    first = RenderBuffer();
+    CHECK(CheckSteady(first, 0, 0.f, MAX_LATENCY_MS, 1.f));
+    CHECK(gOutput[0] != 0.f);
+
+    CHECK(ua_set_latency(3) == UA_SUCCESS); // shorter
+    first = RenderBuffer();
+    CHECK(CheckFade(first, 0, 0.f, MAX_LATENCY_MS, 1.f, 3, 1.f));
+    first = RenderBuffer();
+    CHECK(CheckSteady(first, 1, 100.f, 3, 1.f));
+
+    CHECK(ua_set_latency(7) == UA_SUCCESS); // longer again, from a non-zero delay
+    first = RenderBuffer();
+    CHECK(CheckFade(first, 0, 0.f, 3, 1.f, 7, 1.f));
+    // Run past the end of the ring a few times so both memcpy segments get used.
+    for (int i = 0; i < 10; ++i)
+    {
+        first = RenderBuffer();
+        CHECK(CheckSteady(first, 0, 0.f, 7, 1.f));
+        CHECK(CheckSteady(first, 1, 100.f, 7, 1.f));
+    }
+    return 0;
+}
+
+static int TestRejectedInput(void)
+{
+    ua_ChannelMap map;
+    CHECK(ua_get_channel_map(&map) == UA_SUCCESS);
+    map.connections[0].sinkChannel = NUM_CHANNELS;
+    CHECK(ua_set_channel_map(&map) == UA_FAILURE);
+    map.connections[0].sinkChannel = 0;
+    map.numSinkChannels = NUM_CHANNELS + 1;
+    CHECK(ua_set_channel_map(&map) == UA_FAILURE);
+
+    CHECK(ua_set_scale_factor(map.numConnections, 1.f) == UA_FAILURE);
+    CHECK(ua_set_scale_factor(0, NAN) == UA_FAILURE);
+    CHECK(ua_set_scale_factor(0, INFINITY) == UA_FAILURE);
+    CHECK(ua_set_latency(MAX_LATENCY_MS + 1) == UA_FAILURE);
+    CHECK(ua_gContext.pendingConfig == NULL);
+    return 0;
+}
+
+static int TestReclaim(void)
+{
+    const int Baseline = gNumAllocations;
+    CHECK(ua_set_scale_factor(0, 0.5f) == UA_SUCCESS);
+    CHECK(gNumAllocations == Baseline + 1);
+    RenderBuffer();
+    CHECK(ua_gContext.retiredConfigs != NULL);
+    ua_reclaim();
+    CHECK(ua_gContext.retiredConfigs == NULL);
+    CHECK(gNumAllocations == Baseline);
+    return 0;
+}
+
+int main(void)
+{
+    ua_Settings settings =
+    {
+        .memAllocate = CountingAllocate,
+        .memFree = CountingFree,
+        .audioCallback = FrameCounterCallback,
+        .framesPerBuffer = FRAMES_PER_BUFFER,
+        .maxLatencyMs = MAX_LATENCY_MS,
+        .numChannels = NUM_CHANNELS,
+    };
+    const ua_AudioFormat DeviceFormat = { .sampleRate = SAMPLE_RATE, .numChannels = NUM_CHANNELS };
+    if (!InitContext(&settings, DeviceFormat))
+        return 1;
+
+    // Start without delay; the line is still fed so later latency changes have history.
+    if (ua_set_latency(0) != UA_SUCCESS)
+        return 1;
+    RenderBuffer();
+    ua_reclaim();
+
+    int failed = TestGainAndMapChanges() || TestSupersededConfig() || TestLatencyChanges() ||
+                 TestRejectedInput() || TestReclaim();
+
+    TermContext();
+    if (gNumAllocations != 0)
+    {
+        printf("%d allocation(s) leaked\n", gNumAllocations);
+        failed = 1;
+    }
+    return failed;
+}
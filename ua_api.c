@@ -47,8 +47,26 @@ void ua_term_windows(void);
 #include <mmdeviceapi.h>
 #include <Audioclient.h>
 #undef WIN32_LEAN_AND_MEAN
+#include <math.h>
 #define UA_CHECK(x, ret) do { r = (x); if (!SUCCEEDED(r)) { \
     UA_LOG_ERROR(x); return (ret); } } while(0)
+#else
+// No audio backend: ua_init fails, but the mixing code still builds for host-side tests.
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#ifdef _WIN32
+#define UA_ATOMIC_LOAD_PTR(p) InterlockedCompareExchangePointer((PVOID volatile*)(p), NULL, NULL)
+#define UA_ATOMIC_EXCHANGE_PTR(p, v) InterlockedExchangePointer((PVOID volatile*)(p), (v))
+#define UA_ATOMIC_CAS_PTR(p, expected, desired) \
+    (InterlockedCompareExchangePointer((PVOID volatile*)(p), (desired), (expected)) == (expected))
+#else
+#define UA_ATOMIC_LOAD_PTR(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define UA_ATOMIC_EXCHANGE_PTR(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define UA_ATOMIC_CAS_PTR(p, expected, desired) __atomic_compare_exchange_n((p), &(expected), \
+    (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
 #endif
 
 #define UA_MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -68,69 +86,148 @@ typedef struct ua_AudioFormat
     unsigned char numChannels;
 } ua_AudioFormat;
 
-#define UA_MAX_CHANNEL_CONNECTIONS_PER_MAP 256
-typedef struct ua_ChannelConnection
-{
-    unsigned char sourceChannel;
-    unsigned char sinkChannel;
-    float scaleFactor;
-} ua_ChannelConnection;
-
-typedef struct ua_ChannelMap
-{
-    unsigned char numSourceChannels;
-    unsigned char numSinkChannels;
-
-    unsigned char numConnections;
-    ua_ChannelConnection connections[UA_MAX_CHANNEL_CONNECTIONS_PER_MAP];
-} ua_ChannelMap;
-
 #define UA_TOTAL_PREDEFINED_CHANNEL_MAPS 1
 ua_ChannelMap ua_gChannelMaps[UA_TOTAL_PREDEFINED_CHANNEL_MAPS];
 
-typedef struct ua_Context
+// Everything that can change while the stream is running. Configs are immutable once submitted:
+// the control thread builds a new one and the audio thread swaps it in at a buffer boundary.
+typedef struct ua_Config
 {
     ua_ChannelMap channelMap;
+    unsigned delayFrames;
+    struct ua_Config* nextRetired;
+} ua_Config;
+
+typedef struct ua_Context
+{
+    ua_Config* activeConfig; // audio thread only, once the stream is running
+    ua_Config* latestConfig; // control thread only; the newest submitted config
+    ua_Config* volatile pendingConfig; // control thread -> audio thread
+    ua_Config* volatile retiredConfigs; // audio thread -> control thread
     ua_Settings settings;
     ua_AudioBuffer workBuffer;
-    ua_AudioBuffer delayLine;
+    ua_AudioBuffer delayLine; // ring buffer, frameIndex is the write position
+    ua_AudioBuffer delayedBuffer;
+    ua_AudioBuffer mixBuffer;
     ua_AudioFormat deviceFormat;
-    void (*renderToBufferFunction)(ua_AudioBuffer*);
 } ua_Context;
 ua_Context ua_gContext;
 
-void ApplyDelayLine(ua_AudioBuffer* targetBuffer, ua_AudioBuffer* inBuffer)
+// Copies the input buffer in at the write position, without advancing it.
+void WriteDelayLine(ua_AudioBuffer* delay, const ua_AudioBuffer* inBuffer)
 {
-    const ua_Settings* settings = &ua_gContext.settings;
-    ua_AudioBuffer* delay = &ua_gContext.delayLine;
-    const float* inData = inBuffer->data;
-    const unsigned NumSamples = settings->framesPerBuffer * settings->numChannels;
-    const unsigned NumDelaySamples = delay->numFrames * delay->numChannels;
-    float tmp;
-    float* outData = delay->data;
-    for (unsigned i = 0; i < NumSamples; ++i)
-    {
-        tmp = inData[i];
-        targetBuffer->data[i] = outData[delay->frameIndex];
-        outData[delay->frameIndex] = tmp;
-        delay->frameIndex = (delay->frameIndex + 1) % NumDelaySamples;
+    const unsigned NumChannels = delay->numChannels;
+    const unsigned FirstFrames = UA_MIN(inBuffer->numFrames, delay->numFrames - delay->frameIndex);
+    const unsigned SecondFrames = inBuffer->numFrames - FirstFrames;
+    memcpy(delay->data + delay->frameIndex * NumChannels, inBuffer->data,
+           sizeof(float) * FirstFrames * NumChannels);
+    memcpy(delay->data, inBuffer->data + FirstFrames * NumChannels,
+           sizeof(float) * SecondFrames * NumChannels);
+}
+
+// Copies out the buffer that was written delayFrames ago. Delays shorter than a buffer read into
+// the one just written. The delay line holds the maximum delay plus one buffer, so a read never
+// reaches data older than maxLatencyMs.
+void ReadDelayLine(ua_AudioBuffer* targetBuffer, const ua_AudioBuffer* delay, unsigned delayFrames)
+{
+    const unsigned NumChannels = delay->numChannels;
+    const unsigned ReadIndex = (delay->frameIndex + delay->numFrames - delayFrames) % delay->numFrames;
+    const unsigned FirstFrames = UA_MIN(targetBuffer->numFrames, delay->numFrames - ReadIndex);
+    const unsigned SecondFrames = targetBuffer->numFrames - FirstFrames;
+    memcpy(targetBuffer->data, delay->data + ReadIndex * NumChannels,
+           sizeof(float) * FirstFrames * NumChannels);
+    memcpy(targetBuffer->data + FirstFrames * NumChannels, delay->data,
+           sizeof(float) * SecondFrames * NumChannels);
+}
+
+// Mixes source into the interleaved sink, ramping each connection's gain by gainStep per frame.
+void ApplyChannelMap(ua_AudioBuffer* sink, const ua_AudioBuffer* source, const ua_ChannelMap* map,
+                     float gain, float gainStep)
+{
+    for (unsigned char mapIndex = 0; mapIndex < map->numConnections; ++mapIndex)
+    {
+        const unsigned char SourceChannel = map->connections[mapIndex].sourceChannel;
+        const unsigned char SinkChannel = map->connections[mapIndex].sinkChannel;
+        const float ScaleFactor = map->connections[mapIndex].scaleFactor;
+        float rampedGain = gain;
+        for (unsigned frame = 0; frame < source->numFrames; ++frame)
+        {
+            const float Sample = source->data[frame * source->numChannels + SourceChannel];
+            sink->data[frame * sink->numChannels + SinkChannel] += Sample * ScaleFactor * rampedGain;
+            rampedGain += gainStep;
+        }
     }
 }
 
-void RenderToBuffer(ua_AudioBuffer* targetBuffer)
+const ua_AudioBuffer* ApplyConfigDelay(const ua_Config* config)
 {
-    const unsigned short NumChannels = ua_gContext.settings.numChannels;
-    const unsigned short FramesPerBuffer = ua_gContext.settings.framesPerBuffer;
-    ua_gContext.settings.audioCallback(targetBuffer->data, FramesPerBuffer, NumChannels);
+    if (config->delayFrames == 0)
+        return &ua_gContext.workBuffer;
+
+    ReadDelayLine(&ua_gContext.delayedBuffer, &ua_gContext.delayLine, config->delayFrames);
+    return &ua_gContext.delayedBuffer;
+}
+
+// Audio thread: swaps in the pending config, if any, and returns the one it replaced.
+ua_Config* TakePendingConfig(void)
+{
+    if (UA_ATOMIC_LOAD_PTR(&ua_gContext.pendingConfig) == NULL)
+        return NULL;
+
+    ua_Config* next = UA_ATOMIC_EXCHANGE_PTR(&ua_gContext.pendingConfig, NULL);
+    if (next == NULL)
+        return NULL;
+
+    ua_Config* previous = ua_gContext.activeConfig;
+    ua_gContext.activeConfig = next;
+    return previous;
 }
 
-void RenderToBufferWithDelayLine(ua_AudioBuffer* targetBuffer)
+// Audio thread: hands a config back to the control thread, which frees it.
+void RetireConfig(ua_Config* config)
+{
+    ua_Config* head;
+    do
+    {
+        head = UA_ATOMIC_LOAD_PTR(&ua_gContext.retiredConfigs);
+        config->nextRetired = head;
+    } while (!UA_ATOMIC_CAS_PTR(&ua_gContext.retiredConfigs, head, config));
+}
+
+// Renders one buffer of framesPerBuffer frames into targetBuffer, in the device's channel layout.
+void RenderToBuffer(ua_AudioBuffer* targetBuffer)
 {
     const unsigned short NumChannels = ua_gContext.settings.numChannels;
     const unsigned short FramesPerBuffer = ua_gContext.settings.framesPerBuffer;
-    float* data = ua_gContext.workBuffer.data;
-    ua_gContext.settings.audioCallback(data, FramesPerBuffer, NumChannels);
-    ApplyDelayLine(targetBuffer, &ua_gContext.workBuffer);
+    ua_gContext.settings.audioCallback(ua_gContext.workBuffer.data, FramesPerBuffer, NumChannels);
+    const unsigned NumTargetSamples = targetBuffer->numFrames * targetBuffer->numChannels;
+    memset(targetBuffer->data, 0, sizeof(float) * NumTargetSamples);
+
+    // The delay line is fed even at zero delay, so a longer delay has history to read from.
+    ua_AudioBuffer* delayLine = &ua_gContext.delayLine;
+    if (delayLine->data != NULL)
+        WriteDelayLine(delayLine, &ua_gContext.workBuffer);
+
+    ua_Config* outgoing = TakePendingConfig();
+    const ua_Config* Active = ua_gContext.activeConfig;
+    if (outgoing == NULL)
+    {
+        ApplyChannelMap(targetBuffer, ApplyConfigDelay(Active), &Active->channelMap, 1.f, 0.f);
+    }
+    else
+    {
+        // Crossfade from the outgoing config to the new one over this buffer.
+        const float FadeStep = 1.f / (float)FramesPerBuffer;
+        const ua_AudioBuffer* source = ApplyConfigDelay(outgoing);
+        ApplyChannelMap(targetBuffer, source, &outgoing->channelMap, 1.f, -FadeStep);
+        if (Active->delayFrames != outgoing->delayFrames)
+            source = ApplyConfigDelay(Active);
+        ApplyChannelMap(targetBuffer, source, &Active->channelMap, 0.f, FadeStep);
+        RetireConfig(outgoing);
+    }
+
+    if (delayLine->data != NULL)
+        delayLine->frameIndex = (delayLine->frameIndex + FramesPerBuffer) % delayLine->numFrames;
 }
 
 ua_AudioFormat GetDefaultDeviceFormat(void)
@@ -201,6 +298,9 @@ ua_AudioFormat GetDefaultDeviceFormat(void)
     format.numChannels = (unsigned char)deviceFormatProperties->nChannels;
     format.sampleRate = deviceFormatProperties->nSamplesPerSec; // should be called nFramesPerSec
     return format;
+#else
+    ua_AudioFormat format = { .sampleRate = UA_INVALID_SAMPLE_RATE, .numChannels = 0 };
+    return format;
 #endif
 }
 
@@ -227,35 +327,94 @@ void InitChannelMaps(void)
     maps[0].connections[1].scaleFactor = MINUS_THREE_DB_LINEAR;
 }
 
-ua_SampleRate ua_init(ua_Settings* ua_InitParams)
+unsigned LatencyToFrames(unsigned short latencyMs)
+{
+    const unsigned long long FrameMilliseconds =
+        (unsigned long long)latencyMs * ua_gContext.deviceFormat.sampleRate;
+    return (unsigned)(FrameMilliseconds / 1000);
+}
+
+ua_Config* CreateConfig(const ua_ChannelMap* map, unsigned delayFrames)
 {
-    ua_AudioFormat* deviceFormat = &ua_gContext.deviceFormat;
-    *deviceFormat = GetDefaultDeviceFormat();
-    if (deviceFormat->sampleRate == UA_INVALID_SAMPLE_RATE)
+    ua_Config* config = ua_gContext.settings.memAllocate(sizeof(ua_Config));
+    if (config == NULL)
     {
-        UA_LOG_ERROR(ua_gContext.deviceSampleRate != UA_INVALID_SAMPLE_RATE);
-        return UA_INVALID_SAMPLE_RATE;
+        UA_LOG_ERROR(config != NULL);
+        return NULL;
+    }
+
+    config->channelMap = *map;
+    config->delayFrames = delayFrames;
+    config->nextRetired = NULL;
+    return config;
+}
+
+void ReclaimRetiredConfigs(void)
+{
+    ua_Config* config = UA_ATOMIC_EXCHANGE_PTR(&ua_gContext.retiredConfigs, NULL);
+    while (config != NULL)
+    {
+        ua_Config* next = config->nextRetired;
+        ua_gContext.settings.memFree(config);
+        config = next;
+    }
+}
+
+ua_Result SubmitConfig(ua_Config* config)
+{
+    // A config still pending when the next one arrives never reached the audio thread.
+    ua_Config* superseded = UA_ATOMIC_EXCHANGE_PTR(&ua_gContext.pendingConfig, config);
+    if (superseded != NULL)
+        ua_gContext.settings.memFree(superseded);
+
+    ua_gContext.latestConfig = config;
+    return UA_SUCCESS;
+}
+
+int IsChannelMapValid(const ua_ChannelMap* map)
+{
+    if (map->numSourceChannels != ua_gContext.settings.numChannels ||
+        map->numSinkChannels != ua_gContext.deviceFormat.numChannels)
+    {
+        return 0;
+    }
+
+    for (unsigned char i = 0; i < map->numConnections; ++i)
+    {
+        if (map->connections[i].sourceChannel >= map->numSourceChannels ||
+            map->connections[i].sinkChannel >= map->numSinkChannels)
+        {
+            return 0;
+        }
     }
+    return 1;
+}
+
+// Everything ua_init sets up apart from the platform backend.
+int InitContext(ua_Settings* ua_InitParams, ua_AudioFormat deviceFormat)
+{
+    ua_gContext.deviceFormat = deviceFormat;
 
     InitChannelMaps();
+    ua_ChannelMap channelMap;
     const unsigned char MinConnections =
-        UA_MIN(ua_InitParams->numChannels, deviceFormat->numChannels);
-    ua_gContext.channelMap.numConnections = MinConnections;
-    ua_gContext.channelMap.numSourceChannels = ua_InitParams->numChannels;
-    ua_gContext.channelMap.numSinkChannels = (unsigned char)deviceFormat->numChannels;
-    for (unsigned char i = 0; i < ua_gContext.channelMap.numConnections; ++i)
-    {
-        ua_gContext.channelMap.connections[i].scaleFactor = 1.f;
-        ua_gContext.channelMap.connections[i].sinkChannel = i;
-        ua_gContext.channelMap.connections[i].sourceChannel = i;
+        UA_MIN(ua_InitParams->numChannels, deviceFormat.numChannels);
+    channelMap.numConnections = MinConnections;
+    channelMap.numSourceChannels = ua_InitParams->numChannels;
+    channelMap.numSinkChannels = (unsigned char)deviceFormat.numChannels;
+    for (unsigned char i = 0; i < channelMap.numConnections; ++i)
+    {
+        channelMap.connections[i].scaleFactor = 1.f;
+        channelMap.connections[i].sinkChannel = i;
+        channelMap.connections[i].sourceChannel = i;
     }
 
     for (unsigned i = 0; i < UA_TOTAL_PREDEFINED_CHANNEL_MAPS; ++i)
     {
         if (ua_gChannelMaps[i].numSourceChannels == ua_InitParams->numChannels &&
-            ua_gChannelMaps[i].numSinkChannels == deviceFormat->numChannels)
+            ua_gChannelMaps[i].numSinkChannels == deviceFormat.numChannels)
         {
-            ua_gContext.channelMap = ua_gChannelMaps[i];
+            channelMap = ua_gChannelMaps[i];
             break;
         }
     }
@@ -269,12 +428,6 @@ ua_SampleRate ua_init(ua_Settings* ua_InitParams)
 
     const ua_Settings* settings = &ua_gContext.settings;
 
-    const unsigned FrameMilliseconds = settings->maxLatencyMs * ua_gContext.deviceFormat.sampleRate;
-    ua_AudioBuffer* delayLine = &ua_gContext.delayLine;
-    delayLine->numFrames = FrameMilliseconds / 1000;
-    delayLine->numChannels = settings->numChannels;
-    ua_gContext.delayLine.frameIndex = 0;
-
     const unsigned MaxSamplesPerBuffer = settings->framesPerBuffer * settings->numChannels;
     const unsigned MaxWorkBufferByteCount = sizeof(float) * MaxSamplesPerBuffer;
     ua_AudioBuffer* workBuffer = &ua_gContext.workBuffer;
@@ -282,38 +435,118 @@ ua_SampleRate ua_init(ua_Settings* ua_InitParams)
     if (workBuffer->data == NULL)
     {
         UA_LOG_ERROR(workBuffer->data != NULL);
-        return UA_INVALID_SAMPLE_RATE;
+        return 0;
     }
     workBuffer->numFrames = settings->framesPerBuffer;
     workBuffer->frameIndex = workBuffer->numFrames;
     workBuffer->numChannels = settings->numChannels;
     memset(workBuffer->data, 0, MaxWorkBufferByteCount);
 
-    if (settings->maxLatencyMs != 0) {
-        const unsigned NumDelaySamples = delayLine->numFrames * ua_gContext.delayLine.numChannels;
+    // maxLatencyMs sizes the delay line once; ua_set_latency only moves the read position.
+    const unsigned MaxDelayFrames = LatencyToFrames(settings->maxLatencyMs);
+    ua_AudioBuffer* delayLine = &ua_gContext.delayLine;
+    delayLine->data = NULL;
+    if (MaxDelayFrames != 0)
+    {
+        ua_AudioBuffer* delayedBuffer = &ua_gContext.delayedBuffer;
+        *delayedBuffer = *workBuffer;
+        delayedBuffer->data = settings->memAllocate(MaxWorkBufferByteCount);
+        if (delayedBuffer->data == NULL)
+        {
+            UA_LOG_ERROR(delayedBuffer->data != NULL);
+            return 0;
+        }
+        memset(delayedBuffer->data, 0, MaxWorkBufferByteCount);
+
+        delayLine->numFrames = MaxDelayFrames + settings->framesPerBuffer;
+        delayLine->numChannels = settings->numChannels;
+        delayLine->frameIndex = 0;
+        const unsigned NumDelaySamples = delayLine->numFrames * delayLine->numChannels;
         const unsigned NumDelayBytes = NumDelaySamples * sizeof(float);
-        ua_gContext.delayLine.data = settings->memAllocate(NumDelayBytes);
-        if (ua_gContext.delayLine.data == NULL)
+        delayLine->data = settings->memAllocate(NumDelayBytes);
+        if (delayLine->data == NULL)
         {
-            UA_LOG_ERROR(ua_gContext.delayLine.data != NULL);
-            return UA_INVALID_SAMPLE_RATE;
+            UA_LOG_ERROR(delayLine->data != NULL);
+            return 0;
         }
-        memset(ua_gContext.delayLine.data, 0, NumDelayBytes);
+        memset(delayLine->data, 0, NumDelayBytes);
+    }
 
-        ua_gContext.renderToBufferFunction = RenderToBufferWithDelayLine;
+    ua_gContext.activeConfig = CreateConfig(&channelMap, MaxDelayFrames);
+    if (ua_gContext.activeConfig == NULL)
+        return 0;
+    ua_gContext.latestConfig = ua_gContext.activeConfig;
+    ua_gContext.pendingConfig = NULL;
+    ua_gContext.retiredConfigs = NULL;
+    return 1;
+}
+
+// Frees everything InitContext and the backend's init allocated. The stream must be stopped.
+void TermContext(void)
+{
+    ReclaimRetiredConfigs();
+    ua_Config* pending = UA_ATOMIC_EXCHANGE_PTR(&ua_gContext.pendingConfig, NULL);
+    if (pending != NULL)
+        ua_gContext.settings.memFree(pending);
+    if (ua_gContext.activeConfig != NULL)
+    {
+        ua_gContext.settings.memFree(ua_gContext.activeConfig);
+        ua_gContext.activeConfig = NULL;
     }
-    else
+    ua_gContext.latestConfig = NULL;
+
+    if (ua_gContext.workBuffer.data != NULL)
     {
+        ua_gContext.settings.memFree(ua_gContext.workBuffer.data);
+        ua_gContext.workBuffer.data = NULL;
+    }
+
+    if (ua_gContext.delayLine.data != NULL)
+    {
+        ua_gContext.settings.memFree(ua_gContext.delayLine.data);
         ua_gContext.delayLine.data = NULL;
+    }
+
+    if (ua_gContext.delayedBuffer.data != NULL)
+    {
+        ua_gContext.settings.memFree(ua_gContext.delayedBuffer.data);
+        ua_gContext.delayedBuffer.data = NULL;
+    }
+
+    // Only allocated by backends that drain whole buffers in pieces (macOS).
+    if (ua_gContext.mixBuffer.data != NULL)
+    {
+        ua_gContext.settings.memFree(ua_gContext.mixBuffer.data);
+        ua_gContext.mixBuffer.data = NULL;
+    }
+}
+
+ua_SampleRate ua_init(ua_Settings* ua_InitParams)
+{
+    const ua_AudioFormat DeviceFormat = GetDefaultDeviceFormat();
+    if (DeviceFormat.sampleRate == UA_INVALID_SAMPLE_RATE)
+    {
+        UA_LOG_ERROR(ua_gContext.deviceSampleRate != UA_INVALID_SAMPLE_RATE);
+        return UA_INVALID_SAMPLE_RATE;
+    }
 
-        ua_gContext.renderToBufferFunction = RenderToBuffer;
+    if (!InitContext(ua_InitParams, DeviceFormat))
+    {
+        TermContext();
+        return UA_INVALID_SAMPLE_RATE;
     }
 
 #ifdef __APPLE__
-    return ua_init_macos(ua_InitParams);
+    const ua_SampleRate SampleRate = ua_init_macos(ua_InitParams);
 #elif _WIN32
-    return ua_init_windows(ua_InitParams);
+    const ua_SampleRate SampleRate = ua_init_windows(ua_InitParams);
+#else
+    const ua_SampleRate SampleRate = UA_INVALID_SAMPLE_RATE;
 #endif
+    // Leave nothing behind, so the setters see an uninitialised context and ua_init can retry.
+    if (SampleRate == UA_INVALID_SAMPLE_RATE)
+        TermContext();
+    return SampleRate;
 }
 
 void ua_term(void)
@@ -323,6 +556,77 @@ void ua_term(void)
 #elif _WIN32
     ua_term_windows();
 #endif
+
+    TermContext();
+}
+
+void ua_reclaim(void)
+{
+    ReclaimRetiredConfigs();
+}
+
+ua_Result ua_get_channel_map(ua_ChannelMap* outMap)
+{
+    ReclaimRetiredConfigs();
+    const ua_Config* Latest = ua_gContext.latestConfig;
+    if (Latest == NULL)
+    {
+        UA_LOG_ERROR(Latest != NULL);
+        return UA_FAILURE;
+    }
+
+    *outMap = Latest->channelMap;
+    return UA_SUCCESS;
+}
+
+ua_Result ua_set_channel_map(const ua_ChannelMap* map)
+{
+    ReclaimRetiredConfigs();
+    const ua_Config* Latest = ua_gContext.latestConfig;
+    if (Latest == NULL || !IsChannelMapValid(map))
+    {
+        UA_LOG_ERROR(Latest != NULL && IsChannelMapValid(map));
+        return UA_FAILURE;
+    }
+
+    ua_Config* config = CreateConfig(map, Latest->delayFrames);
+    if (config == NULL)
+        return UA_FAILURE;
+    return SubmitConfig(config);
+}
+
+ua_Result ua_set_scale_factor(unsigned char connectionIndex, float scale)
+{
+    ReclaimRetiredConfigs();
+    const ua_Config* Latest = ua_gContext.latestConfig;
+    if (Latest == NULL || connectionIndex >= Latest->channelMap.numConnections || !isfinite(scale))
+    {
+        UA_LOG_ERROR(Latest != NULL && connectionIndex < Latest->channelMap.numConnections &&
+                     isfinite(scale));
+        return UA_FAILURE;
+    }
+
+    ua_Config* config = CreateConfig(&Latest->channelMap, Latest->delayFrames);
+    if (config == NULL)
+        return UA_FAILURE;
+    config->channelMap.connections[connectionIndex].scaleFactor = scale;
+    return SubmitConfig(config);
+}
+
+ua_Result ua_set_latency(unsigned short latencyMs)
+{
+    ReclaimRetiredConfigs();
+    const ua_Config* Latest = ua_gContext.latestConfig;
+    if (Latest == NULL || latencyMs > ua_gContext.settings.maxLatencyMs)
+    {
+        UA_LOG_ERROR(Latest != NULL && latencyMs <= ua_gContext.settings.maxLatencyMs);
+        return UA_FAILURE;
+    }
+
+    ua_Config* config = CreateConfig(&Latest->channelMap, LatencyToFrames(latencyMs));
+    if (config == NULL)
+        return UA_FAILURE;
+    return SubmitConfig(config);
 }
 
 #ifdef __APPLE__
@@ -334,8 +638,8 @@ static OSStatus RenderCallback(void* inRefCon,
     AudioBufferList* ioData)
 {
     ua_Context* context = (ua_Context*)inRefCon;
-    ua_AudioBuffer* workBuffer = &context->workBuffer;
-    ua_ChannelMap* map = &context->channelMap;
+    ua_AudioBuffer* mixBuffer = &context->mixBuffer;
+    const unsigned NumChannels = UA_MIN(ioData->mNumberBuffers, mixBuffer->numChannels);
 
     for (unsigned channel = 0; channel < ioData->mNumberBuffers; ++channel)
     {
@@ -346,32 +650,28 @@ static OSStatus RenderCallback(void* inRefCon,
     unsigned framesLeft = inNumberFrames;
     while (framesLeft)
     {
-        if (workBuffer->frameIndex >= workBuffer->numFrames)
+        if (mixBuffer->frameIndex >= mixBuffer->numFrames)
         {
-            workBuffer->frameIndex = 0;
-            context->renderToBufferFunction(workBuffer);
+            mixBuffer->frameIndex = 0;
+            RenderToBuffer(mixBuffer);
         }
 
-        const unsigned WorkFrames = workBuffer->numFrames - workBuffer->frameIndex;
-        const unsigned FramesToProcess = WorkFrames < framesLeft ? WorkFrames : framesLeft;
+        const unsigned MixFrames = mixBuffer->numFrames - mixBuffer->frameIndex;
+        const unsigned FramesToProcess = MixFrames < framesLeft ? MixFrames : framesLeft;
 
-        for (unsigned char mapIndex = 0; mapIndex < map->numConnections; ++mapIndex)
+        for (unsigned channel = 0; channel < NumChannels; ++channel)
         {
-            const unsigned char SourceChannel = map->connections[mapIndex].sourceChannel;
-            const unsigned char SinkChannel = map->connections[mapIndex].sinkChannel;
-            const float ScaleFactor = map->connections[mapIndex].scaleFactor;
+            float* buffer = (float*)ioData->mBuffers[channel].mData;
             for (UInt32 i = 0; i < FramesToProcess; ++i)
             {
-                float* buffer = (float*)ioData->mBuffers[SinkChannel].mData;
-                const float Sample = workBuffer->data[(workBuffer->frameIndex + i)
-                    * workBuffer->numChannels + SourceChannel];
-                buffer[frame + i] += Sample * ScaleFactor;
+                buffer[frame + i] = mixBuffer->data[(mixBuffer->frameIndex + i)
+                    * mixBuffer->numChannels + channel];
             }
         }
 
         framesLeft -= FramesToProcess;
         frame += FramesToProcess;
-        workBuffer->frameIndex += FramesToProcess;
+        mixBuffer->frameIndex += FramesToProcess;
     }
 
     return noErr;
@@ -406,6 +706,22 @@ ua_SampleRate ua_init_macos(ua_Settings* ua_InitParams)
         .componentFlagsMask = 0,
     };
 
+    // CoreAudio asks for arbitrary frame counts, so whole buffers are mixed here and drained.
+    const ua_Settings* Settings = &ua_gContext.settings;
+    ua_AudioBuffer* mixBuffer = &ua_gContext.mixBuffer;
+    mixBuffer->numFrames = Settings->framesPerBuffer;
+    mixBuffer->frameIndex = mixBuffer->numFrames;
+    mixBuffer->numChannels = ua_gContext.deviceFormat.numChannels;
+    const unsigned MixBufferByteCount =
+        (unsigned)sizeof(float) * mixBuffer->numFrames * mixBuffer->numChannels;
+    mixBuffer->data = Settings->memAllocate(MixBufferByteCount);
+    if (mixBuffer->data == NULL)
+    {
+        UA_LOG_ERROR(mixBuffer->data != NULL);
+        return UA_INVALID_SAMPLE_RATE;
+    }
+    memset(mixBuffer->data, 0, MixBufferByteCount);
+
     AudioComponent comp = AudioComponentFindNext(NULL, &desc);
     OSStatus s;
     UA_CHECK(AudioComponentInstanceNew(comp, &auHAL), UA_INVALID_SAMPLE_RATE);
@@ -473,27 +789,13 @@ void XAudio2OnBufferEnd(IXAudio2VoiceCallback* This, void* pCtx)
     (void)This;
     ua_XAudio2Buffer* self = (ua_XAudio2Buffer*)pCtx;
     ua_AudioBuffer* sink = &self->buffer;
-    memset(sink->data, 0, sizeof(float) * sink->numChannels * sink->numFrames);
     ua_AudioBuffer* source = &ua_gContext.workBuffer;
     if (source->numFrames != sink->numFrames)
     {
         exit(0); // TODO: not this
     }
 
-    // TODO: this is repeated logic from macOS. Should consolidate.
-    ua_gContext.renderToBufferFunction(source);
-    const ua_ChannelMap* Map = &ua_gContext.channelMap;
-    for (unsigned char mapIndex = 0; mapIndex < Map->numConnections; ++mapIndex)
-    {
-        const unsigned char SourceChannel = Map->connections[mapIndex].sourceChannel;
-        const unsigned char SinkChannel = Map->connections[mapIndex].sinkChannel;
-        const float ScaleFactor = Map->connections[mapIndex].scaleFactor;
-        for (unsigned frame = 0; frame < sink->numFrames; ++frame)
-        {
-            const float Sample = source->data[frame * source->numChannels + SourceChannel];
-            sink->data[frame * sink->numChannels + SinkChannel] += Sample * ScaleFactor;
-        }
-    }
+    RenderToBuffer(sink);
 
     IXAudio2SourceVoice_SubmitSourceBuffer(ua_xAudio2SourceVoice, &self->xAudioBuffer, NULL);
 }
@@ -595,18 +897,6 @@ void ua_term_windows(void)
     {
         ua_gContext.settings.memFree(ua_buffers[i].rawData);
     }
-
-    if (ua_gContext.workBuffer.data != NULL)
-    {
-        ua_gContext.settings.memFree(ua_gContext.workBuffer.data);
-        ua_gContext.workBuffer.data = NULL;
-    }
-
-    if (ua_gContext.delayLine.data != NULL)
-    {
-        ua_gContext.settings.memFree(ua_gContext.delayLine.data);
-        ua_gContext.delayLine.data = NULL;
-    }
 }
 
 #endif
@@ -43,10 +43,39 @@ typedef struct ua_Settings {
     unsigned char numChannels;
 } ua_Settings;
 
+#define UA_MAX_CHANNEL_CONNECTIONS_PER_MAP 256
+typedef struct ua_ChannelConnection {
+    unsigned char sourceChannel;
+    unsigned char sinkChannel;
+    float scaleFactor;
+} ua_ChannelConnection;
+
+typedef struct ua_ChannelMap {
+    unsigned char numSourceChannels;
+    unsigned char numSinkChannels;
+
+    unsigned char numConnections;
+    ua_ChannelConnection connections[UA_MAX_CHANNEL_CONNECTIONS_PER_MAP];
+} ua_ChannelMap;
+
 #define UA_INVALID_SAMPLE_RATE 0
 typedef unsigned ua_SampleRate;
 
+#define UA_FAILURE 0
+#define UA_SUCCESS 1
+typedef int ua_Result;
+
 MICRO_AUDIO_API_EXPORT ua_SampleRate ua_init(ua_Settings* ua_InitParams);
 MICRO_AUDIO_API_EXPORT void ua_term(void);
 
+// Runtime reconfiguration. Call these from one (non-audio) thread, between ua_init and ua_term.
+// Changes are swapped in at the next buffer boundary and crossfaded over one buffer. Replaced
+// state is freed by the next call to any of these, or by ua_reclaim / ua_term.
+MICRO_AUDIO_API_EXPORT ua_Result ua_get_channel_map(ua_ChannelMap* outMap);
+MICRO_AUDIO_API_EXPORT ua_Result ua_set_channel_map(const ua_ChannelMap* map);
+MICRO_AUDIO_API_EXPORT ua_Result ua_set_scale_factor(unsigned char connectionIndex, float scale);
+// latencyMs may not exceed the maxLatencyMs given to ua_init.
+MICRO_AUDIO_API_EXPORT ua_Result ua_set_latency(unsigned short latencyMs);
+MICRO_AUDIO_API_EXPORT void ua_reclaim(void);
+
 #endif // __MICRO_AUDIO_API